@@ -17,12 +17,36 @@
 #include "lwip/sys.h"
 
 #define WIFI_CHANNEL 1
+#define WIFI_CHANNEL_AUTO 0            /*!< channel value which selects the least congested channel by scanning nearby access points */
 #define WIFI_MAX_STA_CONN 1
+#define WIFI_BEACON_INTERVAL 100       /*!< default beacon interval of the access point in TU (1 TU = 1024 us) */
 #define WIFI_SCAN_LIST_SIZE 10
 #define WIFI_STA_CONNECTED_BIT BIT0    /*!< used in event group, this bit represents connected bit */
 #define WIFI_STA_STOP_BIT BIT1         /*!< used in event group, this bit represents stop waiting for connection bit */
 #define WIFI_ERR_NOT_CONNECTED -2      /*!< error code if no device is connected to wifi AP */
 #define WIFI_ERR_ALREADY_RUNNING -3    /*!< error code if access points is already running and `start_wifi_access_point()` is called */
+#define WIFI_ERR_AP_CONFIG -4          /*!< error code if wifi_access_point_config_t passed is invalid */
+
+/**
+ * @brief stores runtime configuration of the access point started by esp32
+ */
+typedef struct wifi_access_point_config
+{
+    uint8_t channel;           /**< channel of the access point, must be allowed by the current country setting, or WIFI_CHANNEL_AUTO to pick the least congested one */
+    uint8_t max_connection;    /**< max number of stations allowed to connect (1-ESP_WIFI_MAX_CONN_NUM) */
+    wifi_auth_mode_t authmode; /**< auth mode of the access point (OPEN, WPA_PSK, WPA2_PSK or WPA_WPA2_PSK), password is ignored for WIFI_AUTH_OPEN */
+    uint16_t beacon_interval;  /**< beacon interval in TU, multiple of 100 in range 100-60000 */
+} wifi_access_point_config_t;
+
+/**
+ * @brief default access point configuration, same as the one used by `start_wifi_access_point()`
+ */
+#define WIFI_ACCESS_POINT_CONFIG_DEFAULT() { \
+    .channel = WIFI_CHANNEL,                 \
+    .max_connection = WIFI_MAX_STA_CONN,     \
+    .authmode = WIFI_AUTH_WPA_WPA2_PSK,      \
+    .beacon_interval = WIFI_BEACON_INTERVAL, \
+}
 
 /**
  * @brief  Tells if any wifi station is connected to wifi access point
@@ -50,8 +74,8 @@ wifi_ap_record_t *scan_wifi_access_point();
 
 /**
  * @brief Starts wifi access point so that other devices can connect to esp32
- * AP. Only one device can be connected to this, can be changed by changing the
- * macro `WIFI_MAX_STA_CONN`.
+ * AP. Uses WIFI_ACCESS_POINT_CONFIG_DEFAULT(), so only one device can be
+ * connected to this, use `start_wifi_access_point_with_config()` to change it.
  * 
  * @param ssid string which contains the name of the ssid of the access point
  * started by esp32
@@ -63,6 +87,31 @@ wifi_ap_record_t *scan_wifi_access_point();
  */
 esp_err_t start_wifi_access_point(char *ssid, char *pass);
 
+/**
+ * @brief Starts wifi access point with the given runtime configuration.
+ * 
+ * If `config->channel` is WIFI_CHANNEL_AUTO, nearby access points are scanned
+ * before the access point is started and every channel allowed by the current
+ * country setting is scored by the number of access points on and around it,
+ * weighted by their RSSI. The channel with the lowest score is used.
+ * 
+ * Note that auto channel mode blocks for an all-channel scan (about 1-2 s)
+ * before the access point comes up, and replaces the list returned by
+ * `scan_wifi_access_point()` and `wifi_access_point_list_size()` with the
+ * results of that scan.
+ * 
+ * @param ssid string which contains the name of the ssid of the access point
+ * started by esp32
+ * @param pass string which contains the password of the ssid of the access
+ * point started by esp32, 8-63 characters unless auth mode is WIFI_AUTH_OPEN
+ * @param config runtime configuration of the access point
+ * @return esp_err_t ESP_OK if access points starts correctly and device connects to 
+ * access point successfully, WIFI_ERR_ALREADY_RUNNING if access point is already
+ * working, WIFI_ERR_AP_CONFIG if config or password is invalid, WIFI_ERR_NOT_CONNECTED if no
+ * device connected to the access point.
+ */
+esp_err_t start_wifi_access_point_with_config(char *ssid, char *pass, const wifi_access_point_config_t *config);
+
 /**
  * @brief Turns off the access point and turns off wifi
  * 
@@ -1,3 +1,4 @@
+#include <stdlib.h>
 #include "wifi_handler_access_point.h"
 
 static const char *WIFI_TAG = "wifi_handler_access_point";
@@ -43,7 +44,15 @@ wifi_ap_record_t *scan_wifi_access_point()
     if (esp_wifi_scan_start(NULL, true) == ESP_OK)
     {
         free(wifi_station_array);
+        wifi_station_array = NULL;
         ESP_ERROR_CHECK(esp_wifi_scan_get_ap_num(&wifi_station_count));
+
+        // nothing to fetch, esp_wifi_scan_get_ap_records() rejects a NULL buffer
+        if (wifi_station_count == 0)
+        {
+            return NULL;
+        }
+
         wifi_station_array = calloc(wifi_station_count, sizeof(wifi_ap_record_t));
 
         ESP_ERROR_CHECK(esp_wifi_scan_get_ap_records(&wifi_station_count, wifi_station_array));
@@ -54,7 +63,129 @@ wifi_ap_record_t *scan_wifi_access_point()
     return NULL;
 }
 
+static bool is_wifi_access_point_authmode_supported(wifi_auth_mode_t authmode)
+{
+    switch (authmode)
+    {
+    case WIFI_AUTH_OPEN:
+    case WIFI_AUTH_WPA_PSK:
+    case WIFI_AUTH_WPA2_PSK:
+    case WIFI_AUTH_WPA_WPA2_PSK:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool is_wifi_access_point_config_valid(const wifi_access_point_config_t *config, const char *pass)
+{
+    if (config == NULL)
+    {
+        return false;
+    }
+
+    if (config->max_connection < 1 || config->max_connection > ESP_WIFI_MAX_CONN_NUM)
+    {
+        return false;
+    }
+
+    if (!is_wifi_access_point_authmode_supported(config->authmode))
+    {
+        return false;
+    }
+
+    // psk auth modes need a 8-63 character passphrase
+    if (config->authmode != WIFI_AUTH_OPEN && (pass == NULL || strlen(pass) < 8 || strlen(pass) > 63))
+    {
+        return false;
+    }
+
+    return config->beacon_interval >= 100 && config->beacon_interval <= 60000 && config->beacon_interval % 100 == 0;
+}
+
+static bool is_wifi_access_point_channel_valid(uint8_t channel)
+{
+    if (channel == WIFI_CHANNEL_AUTO)
+    {
+        return true;
+    }
+
+    // channels allowed depend on the country setting, so driver must be initialised
+    wifi_country_t country;
+    ESP_ERROR_CHECK(esp_wifi_get_country(&country));
+
+    return channel >= country.schan && channel < country.schan + country.nchan;
+}
+
+static uint8_t select_least_congested_channel()
+{
+    wifi_country_t country;
+    ESP_ERROR_CHECK(esp_wifi_get_country(&country));
+
+    // reuse the scan path, wifi_station_array will hold the nearby access points
+    wifi_ap_record_t *ap_list = scan_wifi_access_point();
+    if (ap_list == NULL)
+    {
+        // every channel scores 0 when there are no access points nearby
+        ESP_LOGW(WIFI_TAG, "scan failed or no access points found, using channel %d", country.schan);
+        return country.schan;
+    }
+
+    uint8_t best_channel = country.schan;
+    uint32_t best_score = UINT32_MAX;
+
+    for (uint8_t channel = country.schan; channel < country.schan + country.nchan; channel++)
+    {
+        uint32_t score = 0;
+
+        for (int i = 0; i < wifi_station_count; i++)
+        {
+            // 2.4 GHz channels are 5 MHz apart and 20 MHz wide, so an access point
+            // interferes with channels upto 4 away, less the further away it is
+            int distance = abs((int)channel - (int)ap_list[i].primary);
+
+            // HT40 access points also occupy their secondary channel, 4 channels from the primary
+            if (ap_list[i].second != WIFI_SECOND_CHAN_NONE)
+            {
+                int secondary = ap_list[i].primary + (ap_list[i].second == WIFI_SECOND_CHAN_ABOVE ? 4 : -4);
+                int secondary_distance = abs((int)channel - secondary);
+                distance = secondary_distance < distance ? secondary_distance : distance;
+            }
+
+            if (distance > 4)
+            {
+                continue;
+            }
+
+            // map rssi from -100..0 dBm to 1..101, stronger access points congest more
+            int weight = ap_list[i].rssi + 101;
+            weight = weight >= 1 ? weight : 1;
+
+            score += weight * (5 - distance);
+        }
+
+        ESP_LOGD(WIFI_TAG, "channel %d score %u", channel, (unsigned int)score);
+
+        if (score < best_score)
+        {
+            best_score = score;
+            best_channel = channel;
+        }
+    }
+
+    ESP_LOGI(WIFI_TAG, "selected channel %d (score %u, %d access points nearby)", best_channel, (unsigned int)best_score, wifi_station_count);
+
+    return best_channel;
+}
+
 esp_err_t start_wifi_access_point(char *ssid, char *pass)
+{
+    wifi_access_point_config_t config = WIFI_ACCESS_POINT_CONFIG_DEFAULT();
+
+    return start_wifi_access_point_with_config(ssid, pass, &config);
+}
+
+esp_err_t start_wifi_access_point_with_config(char *ssid, char *pass, const wifi_access_point_config_t *config)
 {
     // if access point is already working, don't try to run this function
     if (is_connected)
@@ -63,6 +194,12 @@ esp_err_t start_wifi_access_point(char *ssid, char *pass)
         return WIFI_ERR_ALREADY_RUNNING;
     }
 
+    if (!is_wifi_access_point_config_valid(config, pass))
+    {
+        ESP_LOGE(WIFI_TAG, "Invalid access point config passed to start_wifi_access_point_with_config()");
+        return WIFI_ERR_AP_CONFIG;
+    }
+
     // set state of connected variable
     is_connected = true;
 
@@ -94,21 +231,54 @@ esp_err_t start_wifi_access_point(char *ssid, char *pass)
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
 
+    if (!is_wifi_access_point_channel_valid(config->channel))
+    {
+        ESP_LOGE(WIFI_TAG, "Channel %d not allowed by current country setting", config->channel);
+
+        // undo the setup done so far, wifi driver was never started so there is nothing to stop
+        ESP_ERROR_CHECK(esp_wifi_clear_default_wifi_driver_and_handlers(wifi_ap_netif_handle));
+        esp_netif_destroy(wifi_ap_netif_handle);
+        wifi_ap_netif_handle = NULL;
+        esp_wifi_deinit();
+        esp_event_loop_delete_default();
+
+        vEventGroupDelete(wifi_event_group);
+        wifi_event_group = NULL;
+        is_connected = false;
+
+        return WIFI_ERR_AP_CONFIG;
+    }
+
     // create instance of event handler, inshort kind of a handle to invoke event handler on receiving certain types of event
     esp_event_handler_instance_t instance_any_id;
 
     // register events that should be handled by the event handler, so if any wifi event, event handler function will be invoked.
     ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler, NULL, &instance_any_id));
 
+    uint8_t channel = config->channel;
+    if (channel == WIFI_CHANNEL_AUTO)
+    {
+        // scanning needs the station interface running, bring it up alone so that
+        // the access point is not advertised before its config is set
+        ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
+        ESP_ERROR_CHECK(esp_wifi_start());
+        channel = select_least_congested_channel();
+        ESP_ERROR_CHECK(esp_wifi_stop());
+    }
+
     wifi_config_t wifi_config = {
         .ap = {
             .ssid_len = strlen(ssid),
-            .channel = WIFI_CHANNEL,
-            .max_connection = WIFI_MAX_STA_CONN,
-            .authmode = WIFI_AUTH_WPA_WPA2_PSK},
+            .channel = channel,
+            .max_connection = config->max_connection,
+            .authmode = config->authmode,
+            .beacon_interval = config->beacon_interval},
     };
     memcpy(wifi_config.ap.ssid, ssid, sizeof(wifi_config.ap.ssid));
-    memcpy(wifi_config.ap.password, pass, sizeof(wifi_config.ap.password));
+    if (config->authmode != WIFI_AUTH_OPEN)
+    {
+        memcpy(wifi_config.ap.password, pass, sizeof(wifi_config.ap.password));
+    }
 
     // set wifi mode to station, i.e. connect to other wifi networks
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_APSTA));